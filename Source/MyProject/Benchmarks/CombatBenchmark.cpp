@@ -0,0 +1,282 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatBenchmark.h"
+
+#if WITH_PERF_AUTOMATION_TESTS
+
+#include "HAL/PlatformProperties.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+#include <atomic>
+
+namespace CombatBenchmark
+{
+	/**
+	 * Forwards everything to the real allocator and counts the allocations made by the game thread while counting is on.
+	 * It is a static and stays valid after it is removed, other threads may still be inside it at that point.
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		void Install()
+		{
+			check(IsInGameThread());
+			if (GMalloc != this)
+			{
+				Inner = GMalloc;
+				GMalloc = this;
+			}
+		}
+
+		void Uninstall()
+		{
+			check(IsInGameThread());
+			if (GMalloc == this)
+			{
+				GMalloc = Inner;
+			}
+		}
+
+		void SetCounting(bool bInCounting) { bCounting.store(bInCounting, std::memory_order_relaxed); }
+
+		uint64 GetAllocationCount() const { return AllocationCount; }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountReallocation(Original, Count);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountReallocation(Original, Count);
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+
+	private:
+		bool IsCounting() const
+		{
+			return FPlatformTLS::GetCurrentThreadId() == GGameThreadId && bCounting.load(std::memory_order_relaxed);
+		}
+
+		void CountAllocation()
+		{
+			if (IsCounting())
+			{
+				++AllocationCount;
+			}
+		}
+
+		// A realloc to zero is a free, and one that fits in the current block doesn't allocate either.
+		// When the allocator can't tell the block size, every realloc to a non zero size is counted.
+		void CountReallocation(void* Original, SIZE_T Count)
+		{
+			if (Count == 0 || !IsCounting())
+			{
+				return;
+			}
+
+			SIZE_T Size = 0;
+			if (!Original || !Inner->GetAllocationSize(Original, Size) || Count > Size)
+			{
+				++AllocationCount;
+			}
+		}
+
+		FMalloc* Inner = nullptr;
+		// Read by every thread that allocates, only the game thread writes it.
+		std::atomic<bool> bCounting{ false };
+		uint64 AllocationCount = 0;
+	};
+
+	static FCountingMalloc CountingMalloc;
+
+	static double GetPercentile(const TArray<double>& SortedSamples, double Percentile)
+	{
+		if (SortedSamples.Num() == 0)
+		{
+			return 0.0;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+		return SortedSamples[Index];
+	}
+}
+
+FCombatBenchmark::FCombatBenchmark(const FString& InSuiteName, int32 InWarmupIterations, int32 InRepetitions)
+	: SuiteName(InSuiteName)
+	, WarmupIterations(InWarmupIterations)
+	, Repetitions(FMath::Max(1, InRepetitions))
+{
+}
+
+const FCombatBenchmark::FTimingResult& FCombatBenchmark::Run(const FString& Name, TFunctionRef<void()> Operation, TFunctionRef<void()> Setup)
+{
+	for (int32 Iteration = 0; Iteration < WarmupIterations; ++Iteration)
+	{
+		Setup();
+		Operation();
+	}
+
+	TArray<double> SamplesNs;
+	SamplesNs.Reserve(Repetitions);
+
+	CombatBenchmark::FCountingMalloc& CountingMalloc = CombatBenchmark::CountingMalloc;
+	CountingMalloc.Install();
+	const uint64 StartAllocations = CountingMalloc.GetAllocationCount();
+
+	for (int32 Repetition = 0; Repetition < Repetitions; ++Repetition)
+	{
+		Setup();
+
+		CountingMalloc.SetCounting(true);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Operation();
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+		CountingMalloc.SetCounting(false);
+
+		SamplesNs.Add(FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1e9);
+	}
+
+	const uint64 Allocations = CountingMalloc.GetAllocationCount() - StartAllocations;
+	CountingMalloc.Uninstall();
+
+	double TotalNs = 0.0;
+	for (const double SampleNs : SamplesNs)
+	{
+		TotalNs += SampleNs;
+	}
+	SamplesNs.Sort();
+
+	FTimingResult& Result = TimingResults.AddDefaulted_GetRef();
+	Result.Name = Name;
+	Result.WarmupIterations = WarmupIterations;
+	Result.Repetitions = Repetitions;
+	Result.MedianNs = CombatBenchmark::GetPercentile(SamplesNs, 0.5);
+	Result.P99Ns = CombatBenchmark::GetPercentile(SamplesNs, 0.99);
+	Result.MeanNs = TotalNs / Repetitions;
+	Result.AllocationsPerOp = static_cast<double>(Allocations) / Repetitions;
+	return Result;
+}
+
+void FCombatBenchmark::RecordSize(const FString& Name, int64 Bits)
+{
+	SizeResults.Add({ Name, Bits });
+}
+
+TArray<FString> FCombatBenchmark::GetSummary() const
+{
+	TArray<FString> Lines;
+	for (const FTimingResult& Result : TimingResults)
+	{
+		Lines.Add(FString::Printf(TEXT("%s: median %.1f ns, p99 %.1f ns, %.2f allocs/op"), *Result.Name, Result.MedianNs, Result.P99Ns, Result.AllocationsPerOp));
+	}
+	for (const FSizeResult& Result : SizeResults)
+	{
+		Lines.Add(FString::Printf(TEXT("%s: %lld bits (%lld bytes)"), *Result.Name, Result.Bits, (Result.Bits + 7) / 8));
+	}
+	return Lines;
+}
+
+FString FCombatBenchmark::WriteJson() const
+{
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("suite"), SuiteName);
+
+	// Changes on every run, diff tooling should skip this object.
+	Writer->WriteObjectStart(TEXT("metadata"));
+	Writer->WriteValue(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Writer->WriteValue(TEXT("platform"), FString(FPlatformProperties::IniPlatformName()));
+	Writer->WriteValue(TEXT("configuration"), FString(LexToString(FApp::GetBuildConfiguration())));
+	Writer->WriteValue(TEXT("build_version"), FString(FApp::GetBuildVersion()));
+	Writer->WriteObjectEnd();
+
+	Writer->WriteArrayStart(TEXT("benchmarks"));
+	for (const FTimingResult& Result : TimingResults)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("name"), Result.Name);
+		Writer->WriteValue(TEXT("warmup"), Result.WarmupIterations);
+		Writer->WriteValue(TEXT("repetitions"), Result.Repetitions);
+		Writer->WriteValue(TEXT("median_ns"), Result.MedianNs);
+		Writer->WriteValue(TEXT("p99_ns"), Result.P99Ns);
+		Writer->WriteValue(TEXT("mean_ns"), Result.MeanNs);
+		Writer->WriteValue(TEXT("allocs_per_op"), Result.AllocationsPerOp);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteArrayStart(TEXT("sizes"));
+	for (const FSizeResult& Result : SizeResults)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("name"), Result.Name);
+		Writer->WriteValue(TEXT("bits"), Result.Bits);
+		Writer->WriteValue(TEXT("bytes"), (Result.Bits + 7) / 8);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	FString OutputDir;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("CombatBenchmarkDir="), OutputDir))
+	{
+		OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"));
+	}
+
+	const FString OutputFile = FPaths::Combine(OutputDir, SuiteName + TEXT(".json"));
+	return FFileHelper::SaveStringToFile(Json, *OutputFile) ? OutputFile : FString();
+}
+
+void FCombatBenchmark::Report(FAutomationTestBase& Test) const
+{
+	for (const FString& Line : GetSummary())
+	{
+		Test.AddInfo(Line);
+	}
+
+	const FString OutputFile = WriteJson();
+	Test.TestFalse(TEXT("Benchmark results written"), OutputFile.IsEmpty());
+	Test.AddInfo(FString::Printf(TEXT("Results written to %s"), *OutputFile));
+}
+
+#endif
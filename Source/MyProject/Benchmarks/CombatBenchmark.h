@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_PERF_AUTOMATION_TESTS
+
+class FAutomationTestBase;
+
+/**
+ * Small harness shared by the combat benchmarks.
+ * Every benchmark runs warmup iterations, then times each repetition on its own and counts the game thread allocations it makes.
+ * Results are written as JSON to Saved/Benchmarks/<Suite>.json, or to the directory given with -CombatBenchmarkDir=<Path>.
+ *
+ * Headless run on Linux:
+ *   MyProject -nullrhi -unattended -ExecCmds="Automation RunTests MyProject.Benchmarks; Quit"
+ */
+class FCombatBenchmark
+{
+public:
+	explicit FCombatBenchmark(const FString& InSuiteName, int32 InWarmupIterations = 100, int32 InRepetitions = 2000);
+
+	struct FTimingResult
+	{
+		FString Name;
+		int32 WarmupIterations;
+		int32 Repetitions;
+		double MedianNs;
+		double P99Ns;
+		double MeanNs;
+		double AllocationsPerOp;
+	};
+
+	struct FSizeResult
+	{
+		FString Name;
+		int64 Bits;
+	};
+
+	// Times Operation. Setup runs before every repetition and is neither timed nor counted.
+	const FTimingResult& Run(const FString& Name, TFunctionRef<void()> Operation, TFunctionRef<void()> Setup = [](){});
+
+	// Records a serialized size in bits, e.g. of an RPC payload.
+	void RecordSize(const FString& Name, int64 Bits);
+
+	// Human readable summary of every result, one line each.
+	TArray<FString> GetSummary() const;
+
+	// Writes all results as JSON. Returns the file written, or an empty string if it couldn't be saved.
+	FString WriteJson() const;
+
+	// Adds the summary to the test log and writes the JSON, failing the test if it couldn't be saved.
+	void Report(FAutomationTestBase& Test) const;
+
+private:
+	FString SuiteName;
+	int32 WarmupIterations;
+	int32 Repetitions;
+
+	TArray<FTimingResult> TimingResults;
+	TArray<FSizeResult> SizeResults;
+};
+
+#endif
@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "CombatBenchmark.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "UObject/CoreNet.h"
+#include "../MyProjectCharacter.h"
+#include "../Scheduling/CombatWorkScheduler.h"
+#include "../HelperLibraries/HelperLibrary.h"
+#include "../ProjectileData/ProjectileActor.h"
+
+#if WITH_PERF_AUTOMATION_TESTS
+
+namespace CombatHotPathBenchmarks
+{
+	/** Bit writer for RPC parameters without a connection. Object references are written as a packed NetGUID. */
+	class FRpcPayloadWriter : public FNetBitWriter
+	{
+	public:
+		FRpcPayloadWriter() : FNetBitWriter(nullptr, 64 * 1024 * 8) {}
+
+		using FNetBitWriter::operator<<;
+
+		virtual FArchive& operator<<(UObject*& Object) override
+		{
+			// Every object gets the same representative dynamic NetGUID, packed into 2 bytes, so sizes only change with the code.
+			uint32 NetGUID = Object ? 2000 : 0;
+			SerializeIntPacked(NetGUID);
+			return *this;
+		}
+	};
+
+	static FProjectileDataStruct MakeProjectileData()
+	{
+		FProjectileDataStruct ProjectileData;
+		ProjectileData.bEnabledProjectileSpawnSystem = true;
+		ProjectileData.ProjectileCollisonProfileName = TEXT("BlockAllDynamic");
+		ProjectileData.bEnabledProjectileCollision = true;
+		ProjectileData.ProjectileMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+		ProjectileData.ProjectileSpeed = 3000.f;
+		ProjectileData.ProjectileVelocity = FVector::ForwardVector;
+		ProjectileData.ProjectileGravityInFloat = 0.f;
+		ProjectileData.ProjectileSize = FVector(0.25f);
+		ProjectileData.bDestroyOnHit = false;
+		ProjectileData.bSendDamageCallbackToBlueprint = false;
+		ProjectileData.DamageAmoutForEnemy = 10.f;
+		ProjectileData.CooldownDelayForShoot = 0.5f;
+		return ProjectileData;
+	}
+
+	/** Fills the parameters of an RPC with representative values and returns the bits they take on the wire. */
+	static int64 GetRpcPayloadBits(UFunction* Function, const FHitResult& SampleHit, UObject* SampleActor, UObject* SampleComponent)
+	{
+		TArray<uint8> Parms;
+		Parms.SetNumZeroed(Function->ParmsSize);
+		Function->InitializeStruct(Parms.GetData());
+
+		FRpcPayloadWriter Writer;
+		for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+		{
+			FProperty* Property = *It;
+			void* Value = Property->ContainerPtrToValuePtr<void>(Parms.GetData());
+
+			if (FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property))
+			{
+				UObject* SampleObject = SampleActor->IsA(ObjectProperty->PropertyClass) ? SampleActor
+					: SampleComponent->IsA(ObjectProperty->PropertyClass) ? SampleComponent : nullptr;
+				Writer << SampleObject;
+				continue;
+			}
+
+			if (FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+			{
+				if (StructProperty->Struct == FHitResult::StaticStruct())
+				{
+					*static_cast<FHitResult*>(Value) = SampleHit;
+				}
+				else if (StructProperty->Struct->IsChildOf(TBaseStructure<FVector>::Get()))
+				{
+					*static_cast<FVector*>(Value) = FVector(1234.f, -5678.f, 90.f);
+				}
+				else if (StructProperty->Struct == TBaseStructure<FRotator>::Get())
+				{
+					*static_cast<FRotator*>(Value) = FRotator(12.3f, 245.6f, 0.f);
+				}
+			}
+			else if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+			{
+				if (NumericProperty->IsInteger())
+				{
+					NumericProperty->SetIntPropertyValue(Value, static_cast<int64>(MAX_int32));
+				}
+				else
+				{
+					NumericProperty->SetFloatingPointPropertyValue(Value, 1234.5);
+				}
+			}
+
+			Property->NetSerializeItem(Writer, nullptr, Value);
+		}
+
+		Function->DestroyStruct(Parms.GetData());
+		return Writer.GetNumBits();
+	}
+}
+
+// Data table lookups, projectile spawn, BeginPlay and reuse, hit dispatch and RPC payload sizes.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatHotPathBenchmarks, "MyProject.Benchmarks.CombatHotPaths",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FCombatHotPathBenchmarks::RunTest(const FString& Parameters)
+{
+	using namespace CombatHotPathBenchmarks;
+
+	const int32 WarmupIterations = 100;
+	const int32 Repetitions = 2000;
+	FCombatBenchmark Benchmark(TEXT("CombatHotPaths"), WarmupIterations, Repetitions);
+
+	const FProjectileDataStruct ProjectileData = MakeProjectileData();
+
+	// Transient table shaped like the content one, with some extra rows so lookups don't hit a single entry map.
+	UDataTable* DataTable = NewObject<UDataTable>(GetTransientPackage());
+	DataTable->AddToRoot();
+	DataTable->RowStruct = FProjectileDataStruct::StaticStruct();
+	for (int32 RowIndex = 0; RowIndex < 63; ++RowIndex)
+	{
+		DataTable->AddRow(FName(*FString::Printf(TEXT("Projectile%d"), RowIndex)), ProjectileData);
+	}
+	DataTable->AddRow(TEXT("HighScore"), ProjectileData);
+
+	Benchmark.Run(TEXT("UHelperLibrary::GetProjectileDataRow"), [&]()
+	{
+		UHelperLibrary::GetProjectileDataRow(DataTable, "HighScore");
+	});
+
+	Benchmark.Run(TEXT("UDataTable::FindRow"), [&]()
+	{
+		DataTable->FindRow<FProjectileDataStruct>("HighScore", "Context", true);
+	});
+
+	if (UDataTable* ContentDataTable = LoadObject<UDataTable>(nullptr, TEXT("/Game/DataTables/ProjectileDataTable.ProjectileDataTable")))
+	{
+		Benchmark.Run(TEXT("UHelperLibrary::GetProjectileDataRow.ContentTable"), [&]()
+		{
+			UHelperLibrary::GetProjectileDataRow(ContentDataTable, "HighScore");
+		});
+	}
+
+	// A game world that has begun play, so spawned projectiles run BeginPlay like they do in game.
+	UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->AddToRoot();
+	GameInstance->InitializeStandalone();
+	UWorld* World = GameInstance->GetWorld();
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	const FVector SpawnLocation(0.f, 0.f, 500.f);
+	const FRotator SpawnRotation(0.f, 90.f, 0.f);
+	const FVector ParkedLocation(0.f, 0.f, 1500.f);
+
+	// Same steps as AMyProjectCharacter::SpawnProjectileShot.
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.bDeferConstruction = true;
+
+	auto SpawnProjectile = [&](const FVector& Location)
+	{
+		AProjectileActor* SpawnedProjectile = World->SpawnActor<AProjectileActor>(AProjectileActor::StaticClass(), Location, SpawnRotation, SpawnParams);
+		SpawnedProjectile->SetReplicates(false);
+		SpawnedProjectile->ProjectileDataTable = DataTable;
+		SpawnedProjectile->FinishSpawning(FTransform(SpawnRotation, Location));
+		return SpawnedProjectile;
+	};
+
+	auto DestroyProjectile = [](AProjectileActor*& SpawnedProjectile)
+	{
+		if (SpawnedProjectile)
+		{
+			SpawnedProjectile->Destroy();
+			SpawnedProjectile = nullptr;
+		}
+	};
+
+	// Used by the benchmarks after the spawn ones, away from where those spawn.
+	AProjectileActor* Projectile = SpawnProjectile(ParkedLocation);
+	TestTrue(TEXT("Projectile has begun play"), Projectile->HasActorBegunPlay());
+	if (!Projectile->ProjectileMeshComponent->GetStaticMesh())
+	{
+		AddWarning(TEXT("Engine sphere mesh not found, projectile benchmarks run without a mesh"));
+	}
+
+	// Destroying the previous projectile untimed keeps a single one alive, so every spawn sees the same world.
+	AProjectileActor* FreshProjectile = nullptr;
+	Benchmark.Run(TEXT("SpawnActor<AProjectileActor>"), [&]()
+	{
+		FreshProjectile = SpawnProjectile(SpawnLocation);
+	}, [&]()
+	{
+		DestroyProjectile(FreshProjectile);
+	});
+
+	// BeginPlay alone. The projectile is spawned untimed with the world's begun play flag cleared, so FinishSpawning
+	// leaves BeginPlay to the timed part, which then runs it the way PostActorConstruction does.
+	Benchmark.Run(TEXT("AProjectileActor::DispatchBeginPlay"), [&]()
+	{
+		FreshProjectile->DispatchBeginPlay();
+	}, [&]()
+	{
+		DestroyProjectile(FreshProjectile);
+		World->bBegunPlay = false;
+		FreshProjectile = SpawnProjectile(SpawnLocation);
+		World->bBegunPlay = true;
+	});
+	DestroyProjectile(FreshProjectile);
+
+	// What reusing a projectile instead of spawning a new one would cost. Setup leaves it somewhere else with the
+	// settings of another weapon, so every repetition moves it and changes its mesh, size and collision.
+	FProjectileDataStruct PreviousProjectileData = ProjectileData;
+	PreviousProjectileData.ProjectileMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	PreviousProjectileData.ProjectileCollisonProfileName = TEXT("OverlapAllDynamic");
+	PreviousProjectileData.ProjectileSize = FVector(0.5f);
+	PreviousProjectileData.ProjectileSpeed = 1500.f;
+	Benchmark.Run(TEXT("ReuseProjectileActor"), [&]()
+	{
+		Projectile->SetActorLocationAndRotation(SpawnLocation, SpawnRotation, false, nullptr, ETeleportType::ResetPhysics);
+		Projectile->ApplyProjectileData(ProjectileData);
+		Projectile->ProjectileMovementComponent->SetVelocityInLocalSpace(FVector::ForwardVector * ProjectileData.ProjectileSpeed);
+	}, [&]()
+	{
+		Projectile->SetActorLocationAndRotation(ParkedLocation, FRotator::ZeroRotator, false, nullptr, ETeleportType::ResetPhysics);
+		Projectile->ApplyProjectileData(PreviousProjectileData);
+	});
+
+	AStaticMeshActor* Target = World->SpawnActor<AStaticMeshActor>(FVector(500.f, 0.f, 500.f), FRotator::ZeroRotator);
+	UPrimitiveComponent* TargetComponent = Target->GetStaticMeshComponent();
+	const FHitResult Hit(Target, TargetComponent, FVector(480.f, 3.f, 510.f), FVector(-1.f, 0.f, 0.f));
+
+	// OnHit only queues the resolution on the server. Ticking the scheduler between repetitions, untimed, keeps the queue
+	// at its steady state size, so this measures the dispatch and not an ever growing backlog.
+	UCombatWorkScheduler* Scheduler = World->GetSubsystem<UCombatWorkScheduler>();
+	Benchmark.Run(TEXT("AProjectileActor::OnHit"), [&]()
+	{
+		Projectile->OnHit(Projectile->CollisionComponent, Target, TargetComponent, FVector::ZeroVector, Hit);
+	}, [&]()
+	{
+		if (Scheduler)
+		{
+			Scheduler->Tick(0.f);
+		}
+	});
+
+	Benchmark.Run(TEXT("AProjectileActor::OnProjectileHit_Server"), [&]()
+	{
+		Projectile->OnProjectileHit_Server_Implementation(Target, TargetComponent, Hit);
+	});
+
+	// Parameter payload only, bunch and RPC headers come on top of it.
+	const TPair<UClass*, FName> Rpcs[] = {
+		{ AMyProjectCharacter::StaticClass(), TEXT("SpawnProjectile") },
+		{ AMyProjectCharacter::StaticClass(), TEXT("SpawnProjectileClient") },
+		{ AProjectileActor::StaticClass(), TEXT("OnProjectileHit_Server") },
+		{ AProjectileActor::StaticClass(), TEXT("OnProjectileHit_Client") },
+	};
+	for (const TPair<UClass*, FName>& Rpc : Rpcs)
+	{
+		UFunction* Function = Rpc.Key->FindFunctionByName(Rpc.Value);
+		if (TestNotNull(FString::Printf(TEXT("RPC %s"), *Rpc.Value.ToString()), Function))
+		{
+			Benchmark.RecordSize(FString::Printf(TEXT("%s::%s.Payload"), *Rpc.Key->GetName(), *Rpc.Value.ToString()),
+				GetRpcPayloadBits(Function, Hit, Target, TargetComponent));
+		}
+	}
+
+	GameInstance->Shutdown();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	GameInstance->RemoveFromRoot();
+	DataTable->RemoveFromRoot();
+
+	Benchmark.Report(*this);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "CombatBenchmark.h"
+#include "Engine/NetSerialization.h"
+#include "UObject/CoreNet.h"
+#include "../HelperLibraries/HelperLibrary.h"
+
+#if WITH_PERF_AUTOMATION_TESTS
+
+// Measures how expanding one fire command into pellets scales with the pellet count.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProjectileSpreadBenchmark, "MyProject.Benchmarks.ProjectileSpread",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FProjectileSpreadBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 PelletCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+	FCombatBenchmark Benchmark(TEXT("ProjectileSpread"));
+
+	FProjectileDataStruct ProjectileData;
+	ProjectileData.SpreadConeHalfAngle = 10.f;
+
+	// Server and clients expand the pellets from the fire transform. The server's quantized copy must match what clients read from the RPC.
+	const FVector SampleLocations[] = { FVector(1234.56f, -78.9f, 301.49f), FVector(-0.5f, 0.5f, -1.5f), FVector(98765.4f, -43210.9f, 12.51f) };
+	const FRotator SampleRotations[] = { FRotator(-12.34f, 245.67f, 0.5f), FRotator(89.9f, -179.99f, -0.01f), FRotator(0.f, 359.999f, 360.f) };
+	for (int32 SampleIndex = 0; SampleIndex < UE_ARRAY_COUNT(SampleLocations); ++SampleIndex)
+	{
+		FVector QuantizedLocation = SampleLocations[SampleIndex];
+		FRotator QuantizedRotation = SampleRotations[SampleIndex];
+		UHelperLibrary::QuantizeFireTransform(QuantizedLocation, QuantizedRotation);
+
+		bool bSuccess = true;
+		FVector_NetQuantize SentLocation = SampleLocations[SampleIndex];
+		FRotator SentRotation = SampleRotations[SampleIndex];
+		FNetBitWriter Writer(nullptr, 1024);
+		SentLocation.NetSerialize(Writer, nullptr, bSuccess);
+		SentRotation.NetSerialize(Writer, nullptr, bSuccess);
+
+		FVector_NetQuantize ReceivedLocation;
+		FRotator ReceivedRotation;
+		FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+		ReceivedLocation.NetSerialize(Reader, nullptr, bSuccess);
+		ReceivedRotation.NetSerialize(Reader, nullptr, bSuccess);
+
+		TestTrue(FString::Printf(TEXT("Fire transform %d serialized"), SampleIndex), bSuccess && !Reader.IsError());
+		TestTrue(FString::Printf(TEXT("Fire location %d matches the wire"), SampleIndex), FVector(ReceivedLocation) == QuantizedLocation);
+		TestTrue(FString::Printf(TEXT("Fire rotation %d matches the wire"), SampleIndex), ReceivedRotation == QuantizedRotation);
+	}
+
+	const FRotator AimRotation(0.f, 45.f, 0.f);
+	const float MaxPelletAngleCos = FMath::Cos(FMath::DegreesToRadians(ProjectileData.SpreadConeHalfAngle)) - KINDA_SMALL_NUMBER;
+	TArray<FRotator> PelletRotations;
+
+	for (const int32 PelletCount : PelletCounts)
+	{
+		ProjectileData.PelletCount = PelletCount;
+
+		UHelperLibrary::GetProjectileSpreadRotations(ProjectileData, 1234, 0, AimRotation, PelletRotations);
+		TestEqual(FString::Printf(TEXT("Pellet count for %d pellets"), PelletCount), PelletRotations.Num(), PelletCount);
+		for (const FRotator& PelletRotation : PelletRotations)
+		{
+			if (!TestTrue(FString::Printf(TEXT("Pellets inside the spread cone for %d pellets"), PelletCount),
+				FVector::DotProduct(PelletRotation.Vector(), AimRotation.Vector()) >= MaxPelletAngleCos))
+			{
+				break;
+			}
+		}
+
+		int32 FireSeed = 0;
+		Benchmark.Run(FString::Printf(TEXT("GetProjectileSpreadRotations.Pellets%d"), PelletCount), [&]()
+		{
+			UHelperLibrary::GetProjectileSpreadRotations(ProjectileData, ++FireSeed, 0, AimRotation, PelletRotations);
+		});
+	}
+
+	Benchmark.Report(*this);
+
+	return true;
+}
+
+#endif
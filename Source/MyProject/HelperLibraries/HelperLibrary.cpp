@@ -3,3 +3,39 @@
 
 #include "HelperLibrary.h"
 
+
+int32 UHelperLibrary::GetProjectileShotSeed(int32 FireSeed, int32 ShotIndex)
+{
+	return static_cast<int32>(HashCombine(static_cast<uint32>(FireSeed), static_cast<uint32>(ShotIndex)));
+}
+
+void UHelperLibrary::GetProjectileSpreadRotations(const FProjectileDataStruct& ProjectileData, int32 FireSeed, int32 ShotIndex, const FRotator& AimRotation, TArray<FRotator>& OutRotations)
+{
+	const int32 PelletCount = FMath::Max(1, ProjectileData.PelletCount);
+	const float ConeHalfAngleRad = FMath::DegreesToRadians(FMath::Clamp(ProjectileData.SpreadConeHalfAngle, 0.f, 90.f));
+
+	// No spread, every pellet flies along the aim direction.
+	if (ConeHalfAngleRad <= 0.f)
+	{
+		OutRotations.Init(AimRotation, PelletCount);
+		return;
+	}
+
+	OutRotations.Reset(PelletCount);
+	FRandomStream SpreadStream(GetProjectileShotSeed(FireSeed, ShotIndex));
+	const FVector AimDirection = AimRotation.Vector();
+	for (int32 PelletIndex = 0; PelletIndex < PelletCount; ++PelletIndex)
+	{
+		OutRotations.Add(SpreadStream.VRandCone(AimDirection, ConeHalfAngleRad).Rotation());
+	}
+}
+
+void UHelperLibrary::QuantizeFireTransform(FVector& FireLocation, FRotator& FireRotation)
+{
+	// FVector_NetQuantize keeps whole units, FRotator is sent as compressed shorts.
+	FireLocation = FVector(FMath::RoundToFloat(FireLocation.X), FMath::RoundToFloat(FireLocation.Y), FMath::RoundToFloat(FireLocation.Z));
+	FireRotation = FRotator(
+		FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(FireRotation.Pitch)),
+		FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(FireRotation.Yaw)),
+		FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(FireRotation.Roll)));
+}
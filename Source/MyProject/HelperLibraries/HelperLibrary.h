@@ -64,6 +64,22 @@ struct FProjectileDataStruct :  public FTableRowBase
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 		float CooldownDelayForShoot;
 
+	// Number of projectiles spawned by every shot. Shotgun style weapons use more than one.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "1"))
+		int32 PelletCount = 1;
+
+	// Half angle in degrees of the cone the pellets are spread in. 0 fires every pellet straight ahead.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0", ClampMax = "90"))
+		float SpreadConeHalfAngle = 0.f;
+
+	// Number of shots fired by one trigger pull.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "1"))
+		int32 BurstShotCount = 1;
+
+	// Delay in seconds between two shots of a burst.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = "0"))
+		float BurstShotInterval = 0.1f;
+
 };
 
 UCLASS()
@@ -85,4 +101,14 @@ public:
 		return nullptr;
 	} 
 
+	// Seed of one shot of a burst, derived from the seed carried by the fire command.
+	static int32 GetProjectileShotSeed(int32 FireSeed, int32 ShotIndex);
+
+	// Expands one shot into the rotation of every pellet. Same seed and shot index always give the same pellets,
+	// so server and clients can spawn them from a single fire command.
+	static void GetProjectileSpreadRotations(const FProjectileDataStruct& ProjectileData, int32 FireSeed, int32 ShotIndex, const FRotator& AimRotation, TArray<FRotator>& OutRotations);
+
+	// Rounds fire location and rotation the same way the multicast RPC does, so the server expands the exact values clients receive.
+	static void QuantizeFireTransform(FVector& FireLocation, FRotator& FireRotation);
+
 };
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatLLM.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+
+DECLARE_LLM_MEMORY_STAT(TEXT("Combat Projectiles"), STAT_CombatProjectilesLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("Combat Projectiles"), STAT_CombatProjectilesSummaryLLM, STATGROUP_LLM);
+DECLARE_LLM_MEMORY_STAT(TEXT("Combat Characters"), STAT_CombatCharactersLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("Combat Characters"), STAT_CombatCharactersSummaryLLM, STATGROUP_LLM);
+DECLARE_LLM_MEMORY_STAT(TEXT("Combat Manager"), STAT_CombatManagerLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("Combat Manager"), STAT_CombatManagerSummaryLLM, STATGROUP_LLM);
+
+int64 GetCombatLLMTagAmount(ECombatLLMTag Tag)
+{
+	if (!FLowLevelMemTracker::IsEnabled())
+	{
+		return 0;
+	}
+	RegisterCombatLLMTags();
+	return FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, static_cast<ELLMTag>(Tag));
+}
+
+#endif
+
+void RegisterCombatLLMTags()
+{
+	// Thread safe, scopes are also opened by scheduler work on worker threads.
+	static const bool bRegistered = []()
+	{
+		LLM(FLowLevelMemTracker::Get().RegisterProjectTag(static_cast<int32>(ECombatLLMTag::Projectiles), TEXT("CombatProjectiles"), GET_STATFNAME(STAT_CombatProjectilesLLM), GET_STATFNAME(STAT_CombatProjectilesSummaryLLM)));
+		LLM(FLowLevelMemTracker::Get().RegisterProjectTag(static_cast<int32>(ECombatLLMTag::Characters), TEXT("CombatCharacters"), GET_STATFNAME(STAT_CombatCharactersLLM), GET_STATFNAME(STAT_CombatCharactersSummaryLLM)));
+		LLM(FLowLevelMemTracker::Get().RegisterProjectTag(static_cast<int32>(ECombatLLMTag::CombatManager), TEXT("CombatManager"), GET_STATFNAME(STAT_CombatManagerLLM), GET_STATFNAME(STAT_CombatManagerSummaryLLM)));
+		return true;
+	}();
+	(void)bRegistered;
+}
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+
+// Low level memory tracker tags of the combat code. Shown by "stat LLM" and "stat LLMFULL" when running with -llm.
+enum class ECombatLLMTag : int32
+{
+	Projectiles = static_cast<int32>(ELLMTag::ProjectTagStart),
+	// Player and AI characters, they share AMyProjectCharacter.
+	Characters,
+	// Combat work scheduler and memory tracker.
+	CombatManager,
+};
+
+// Registers the tags on first use, see RegisterCombatLLMTags.
+#define COMBAT_LLM_SCOPE(Tag) RegisterCombatLLMTags(); LLM_SCOPE(static_cast<ELLMTag>(ECombatLLMTag::Tag))
+
+// Returns the bytes currently tracked under a combat tag, or 0 if LLM isn't running.
+MYPROJECT_API int64 GetCombatLLMTagAmount(ECombatLLMTag Tag);
+
+#else
+
+#define COMBAT_LLM_SCOPE(Tag)
+
+#endif
+
+// Registers the combat tags with the low level memory tracker, only the first call does anything.
+// Every COMBAT_LLM_SCOPE calls it, so the tags are known before the first tagged allocation in both link modes:
+// modular builds construct the default objects of the module when it loads, monolithic ones during engine pre-init,
+// before any game module is created.
+MYPROJECT_API void RegisterCombatLLMTags();
@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatMemoryTracker.h"
+#include "CombatLLM.h"
+#include "EngineUtils.h"
+#include "Engine/ActorChannel.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "../MyProjectCharacter.h"
+#include "../ProjectileData/ProjectileActor.h"
+#include "../Scheduling/CombatWorkScheduler.h"
+
+DEFINE_LOG_CATEGORY(LogCombatMemory);
+
+static TAutoConsoleVariable<float> CVarCombatProjectileBudgetMB(
+	TEXT("Combat.Memory.ProjectileBudgetMB"),
+	32.f,
+	TEXT("Warn when the estimated memory of all live projectiles goes over this many megabytes. 0 or less disables the warning."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CombatMemoryDumpCommand(
+	TEXT("Combat.Memory.Dump"),
+	TEXT("Prints projectile, character and combat manager memory by category. Add -instances for one line per actor."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UCombatMemoryTracker* Tracker = UCombatMemoryTracker::Get(World))
+		{
+			Tracker->DumpMemory(Ar, Args.Contains(TEXT("-instances")));
+		}
+	}));
+
+static FString FormatBytes(uint64 Bytes)
+{
+	return FString::Printf(TEXT("%.1f KB"), Bytes / 1024.0);
+}
+
+static void LogUsage(FOutputDevice& Ar, const FString& Name, const FCombatMemoryUsage& Usage)
+{
+	Ar.Logf(TEXT("  %s: actor %s, components %s, physics %s, replication %s, total %s"), *Name,
+		*FormatBytes(Usage.ActorBytes), *FormatBytes(Usage.ComponentBytes), *FormatBytes(Usage.PhysicsBytes),
+		*FormatBytes(Usage.ReplicationBytes), *FormatBytes(Usage.GetTotalBytes()));
+}
+
+
+UCombatMemoryTracker* UCombatMemoryTracker::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UCombatMemoryTracker>() : nullptr;
+}
+
+FCombatMemoryUsage UCombatMemoryTracker::MeasureActor(AActor* Actor)
+{
+	FCombatMemoryUsage Usage;
+	if (!IsValid(Actor))
+	{
+		return Usage;
+	}
+
+	Usage.ActorBytes = FArchiveCountMem(Actor).GetMax();
+
+	TInlineComponentArray<UActorComponent*> Components(Actor);
+	for (UActorComponent* Component : Components)
+	{
+		Usage.ComponentBytes += FArchiveCountMem(Component).GetMax();
+
+		if (UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component))
+		{
+			FResourceSizeEx PhysicsSize(EResourceSizeMode::Exclusive);
+			Primitive->BodyInstance.GetBodyInstanceResourceSizeEx(PhysicsSize);
+			Usage.PhysicsBytes += PhysicsSize.GetTotalMemoryBytes();
+		}
+	}
+
+	// Only the server has a channel per client, clients keep a single one for the actor.
+	if (UNetDriver* NetDriver = Actor->GetNetDriver())
+	{
+		TArray<UNetConnection*> Connections = NetDriver->ClientConnections;
+		if (NetDriver->ServerConnection)
+		{
+			Connections.Add(NetDriver->ServerConnection);
+		}
+		for (UNetConnection* Connection : Connections)
+		{
+			if (UActorChannel* Channel = Connection ? Connection->FindActorChannelRef(Actor) : nullptr)
+			{
+				Usage.ReplicationBytes += FArchiveCountMem(Channel).GetMax();
+			}
+		}
+	}
+
+	return Usage;
+}
+
+void UCombatMemoryTracker::RegisterProjectile(AProjectileActor* Projectile)
+{
+	COMBAT_LLM_SCOPE(CombatManager);
+
+	LiveProjectiles.Add(Projectile);
+
+	// Projectiles of a weapon are all alike, one measurement is enough for the estimate.
+	if (EstimatedBytesPerProjectile == 0)
+	{
+		EstimatedBytesPerProjectile = MeasureActor(Projectile).GetTotalBytes();
+	}
+
+	CheckProjectileBudget();
+}
+
+void UCombatMemoryTracker::UnregisterProjectile(AProjectileActor* Projectile)
+{
+	LiveProjectiles.Remove(Projectile);
+	CheckProjectileBudget();
+}
+
+void UCombatMemoryTracker::CheckProjectileBudget()
+{
+	const float BudgetMB = CVarCombatProjectileBudgetMB.GetValueOnGameThread();
+	if (BudgetMB <= 0.f)
+	{
+		bProjectilesOverBudget = false;
+		return;
+	}
+
+	const uint64 BudgetBytes = static_cast<uint64>(BudgetMB * 1024.0 * 1024.0);
+	const uint64 EstimatedBytes = GetEstimatedProjectileBytes();
+
+	if (!bProjectilesOverBudget && EstimatedBytes > BudgetBytes)
+	{
+		bProjectilesOverBudget = true;
+		UE_LOG(LogCombatMemory, Warning, TEXT("Live projectile memory over budget: %d projectiles, about %.2f MB of %.2f MB (%s each)."),
+			LiveProjectiles.Num(), EstimatedBytes / (1024.0 * 1024.0), BudgetMB, *FormatBytes(EstimatedBytesPerProjectile));
+	}
+	// Re-arm a little below the budget so a count hovering around it doesn't spam the log.
+	else if (bProjectilesOverBudget && EstimatedBytes < BudgetBytes * 9 / 10)
+	{
+		bProjectilesOverBudget = false;
+	}
+}
+
+void UCombatMemoryTracker::DumpMemory(FOutputDevice& Ar, bool bPerInstance)
+{
+	UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = World->GetNetDriver();
+	const int32 NumClientConnections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+
+	Ar.Logf(TEXT("Combat memory for %s, %d client connections"), *World->GetName(), NumClientConnections);
+
+	FCombatMemoryUsage ProjectileTotal;
+	int32 NumProjectiles = 0;
+	Ar.Logf(TEXT("Projectiles:"));
+	for (const TWeakObjectPtr<AProjectileActor>& Projectile : LiveProjectiles)
+	{
+		if (!Projectile.IsValid())
+		{
+			continue;
+		}
+
+		const FCombatMemoryUsage Usage = MeasureActor(Projectile.Get());
+		ProjectileTotal += Usage;
+		++NumProjectiles;
+
+		if (bPerInstance)
+		{
+			LogUsage(Ar, Projectile->GetName(), Usage);
+		}
+	}
+	if (NumProjectiles > 0)
+	{
+		EstimatedBytesPerProjectile = ProjectileTotal.GetTotalBytes() / NumProjectiles;
+	}
+	LogUsage(Ar, FString::Printf(TEXT("Total of %d"), NumProjectiles), ProjectileTotal);
+	Ar.Logf(TEXT("  Per projectile %s, budget %.2f MB"), *FormatBytes(EstimatedBytesPerProjectile), CVarCombatProjectileBudgetMB.GetValueOnGameThread());
+
+	FCombatMemoryUsage AITotal;
+	FCombatMemoryUsage PlayerTotal;
+	int32 NumAI = 0;
+	int32 NumPlayers = 0;
+	Ar.Logf(TEXT("Characters:"));
+	for (TActorIterator<AMyProjectCharacter> It(World); It; ++It)
+	{
+		const FCombatMemoryUsage Usage = MeasureActor(*It);
+		const bool bIsAI = !It->IsPlayerControlled();
+		if (bIsAI)
+		{
+			AITotal += Usage;
+			++NumAI;
+		}
+		else
+		{
+			PlayerTotal += Usage;
+			++NumPlayers;
+		}
+
+		if (bPerInstance)
+		{
+			LogUsage(Ar, FString::Printf(TEXT("%s (%s)"), *It->GetName(), bIsAI ? TEXT("AI") : TEXT("player")), Usage);
+		}
+	}
+	LogUsage(Ar, FString::Printf(TEXT("Total of %d AI"), NumAI), AITotal);
+	LogUsage(Ar, FString::Printf(TEXT("Total of %d players"), NumPlayers), PlayerTotal);
+	if (NumClientConnections > 0)
+	{
+		Ar.Logf(TEXT("  Replication per client connection %s"),
+			*FormatBytes((ProjectileTotal.ReplicationBytes + AITotal.ReplicationBytes + PlayerTotal.ReplicationBytes) / NumClientConnections));
+	}
+
+	Ar.Logf(TEXT("Combat manager:"));
+	if (const UCombatWorkScheduler* Scheduler = World->GetSubsystem<UCombatWorkScheduler>())
+	{
+		Ar.Logf(TEXT("  Work scheduler %s, %d pending work items"), *FormatBytes(Scheduler->GetAllocatedSize()), Scheduler->GetNumPendingWork());
+	}
+	Ar.Logf(TEXT("  Memory tracker %s"), *FormatBytes(sizeof(*this) + LiveProjectiles.GetAllocatedSize()));
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if (FLowLevelMemTracker::IsEnabled())
+	{
+		Ar.Logf(TEXT("LLM tags: projectiles %s, characters %s, combat manager %s"),
+			*FormatBytes(GetCombatLLMTagAmount(ECombatLLMTag::Projectiles)),
+			*FormatBytes(GetCombatLLMTagAmount(ECombatLLMTag::Characters)),
+			*FormatBytes(GetCombatLLMTagAmount(ECombatLLMTag::CombatManager)));
+	}
+#endif
+}
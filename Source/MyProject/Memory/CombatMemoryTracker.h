@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatMemoryTracker.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatMemory, Log, All);
+
+class AProjectileActor;
+
+// Memory of one actor, split by category.
+struct FCombatMemoryUsage
+{
+	// The actor object itself.
+	uint64 ActorBytes = 0;
+	// All of its components, not counting their physics bodies.
+	uint64 ComponentBytes = 0;
+	// Physics bodies of its primitive components.
+	uint64 PhysicsBytes = 0;
+	// Actor channels and replicators of every client connection.
+	uint64 ReplicationBytes = 0;
+
+	uint64 GetTotalBytes() const { return ActorBytes + ComponentBytes + PhysicsBytes + ReplicationBytes; }
+
+	FCombatMemoryUsage& operator+=(const FCombatMemoryUsage& Other)
+	{
+		ActorBytes += Other.ActorBytes;
+		ComponentBytes += Other.ComponentBytes;
+		PhysicsBytes += Other.PhysicsBytes;
+		ReplicationBytes += Other.ReplicationBytes;
+		return *this;
+	}
+};
+
+/**
+ * Keeps track of live projectiles and warns when their estimated memory goes over budget.
+ * Budget is set with the console variable Combat.Memory.ProjectileBudgetMB, "Combat.Memory.Dump [-instances]" prints the full report.
+ */
+UCLASS()
+class MYPROJECT_API UCombatMemoryTracker : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Returns the tracker of the world, or nullptr if there is none.
+	static UCombatMemoryTracker* Get(const UObject* WorldContextObject);
+
+	// Measures the memory of an actor and its components.
+	static FCombatMemoryUsage MeasureActor(AActor* Actor);
+
+	// Called by projectiles in BeginPlay and EndPlay.
+	void RegisterProjectile(AProjectileActor* Projectile);
+	void UnregisterProjectile(AProjectileActor* Projectile);
+
+	int32 GetNumLiveProjectiles() const { return LiveProjectiles.Num(); }
+
+	// Live projectiles times the measured size of one projectile.
+	uint64 GetEstimatedProjectileBytes() const { return LiveProjectiles.Num() * EstimatedBytesPerProjectile; }
+
+	// Writes per category totals, and one line per projectile and character when bPerInstance is set.
+	void DumpMemory(FOutputDevice& Ar, bool bPerInstance);
+
+private:
+	void CheckProjectileBudget();
+
+	TSet<TWeakObjectPtr<AProjectileActor>> LiveProjectiles;
+
+	// Measured on the first projectile, refreshed by every dump.
+	uint64 EstimatedBytesPerProjectile = 0;
+
+	// Set while over budget so the warning is logged once per crossing.
+	bool bProjectilesOverBudget = false;
+};
@@ -8,12 +8,19 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "Memory/CombatLLM.h"
+#include "Scheduling/CombatWorkScheduler.h"
 
 //////////////////////////////////////////////////////////////////////////
 // AMyProjectCharacter
 
 AMyProjectCharacter::AMyProjectCharacter()
 {
+	// The data table belongs to content, not to the character, keep it out of the characters tag.
+	InitDataTable();
+
+	COMBAT_LLM_SCOPE(Characters);
+
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
 
@@ -50,9 +57,21 @@ AMyProjectCharacter::AMyProjectCharacter()
 
 	bReplicates = true;
 	SetReplicateMovement(true) ;
-	
+}
 
-	InitDataTable();
+void AMyProjectCharacter::PostInitializeComponents()
+{
+	// Movement setup and, for AI, spawning the default controller.
+	COMBAT_LLM_SCOPE(Characters);
+
+	Super::PostInitializeComponents();
+}
+
+void AMyProjectCharacter::BeginPlay()
+{
+	COMBAT_LLM_SCOPE(Characters);
+
+	Super::BeginPlay();
 }
 
 
@@ -108,8 +127,26 @@ void AMyProjectCharacter::StartCoolDownTimer(float ResetDelay)
 // Server -> Client -> RPC
 void AMyProjectCharacter::SpawnProjectile_Implementation()
 {
-	
-	SpawnProjectileClient_Implementation();
+	// do nothing if cooldown is active
+	if (AllowToShoot == false)
+	{
+		return;
+	}
+
+	FProjectileDataStruct* dataTableData = UHelperLibrary::GetProjectileDataRow(ProjectileDataTable, "HighScore");
+	if (!dataTableData)
+	{
+		return;
+	}
+
+	// cooldown timer start
+	StartCoolDownTimer(dataTableData->CooldownDelayForShoot);
+
+	// One seed per trigger pull. Server and clients expand it into the same pellets and burst shots.
+	FVector FireLocation = GetProjectileFireLocation();
+	FRotator FireRotation = GetActorRotation();
+	UHelperLibrary::QuantizeFireTransform(FireLocation, FireRotation);
+	SpawnProjectileClient(FMath::Rand(), FireLocation, FireRotation);
 
 	// Can be used later, for server only event
 	if (IsLocallyControlled())
@@ -117,36 +154,102 @@ void AMyProjectCharacter::SpawnProjectile_Implementation()
 	}
 }
 
-void AMyProjectCharacter::SpawnProjectileClient_Implementation()
+void AMyProjectCharacter::SpawnProjectileClient_Implementation(int32 FireSeed, FVector_NetQuantize FireLocation, FRotator FireRotation)
 {
-	// do nothing if cooldown is active
-	if (AllowToShoot == false)
+	// A new fire command replaces whatever is left of the previous burst.
+	GetWorldTimerManager().ClearTimer(BurstTimerHandle);
+
+	BurstFireSeed = FireSeed;
+	BurstFireLocation = FireLocation;
+	BurstFireRotation = FireRotation;
+	BurstShotIndex = 0;
+
+	SpawnNextBurstShot();
+}
+
+void AMyProjectCharacter::SpawnNextBurstShot()
+{
+	FProjectileDataStruct* dataTableData = UHelperLibrary::GetProjectileDataRow(ProjectileDataTable, "HighScore");
+	if (!dataTableData || !dataTableData->bEnabledProjectileSpawnSystem)
 	{
 		return;
 	}
 
-	FProjectileDataStruct* dataTableData = ProjectileDataTable->FindRow<FProjectileDataStruct>("HighScore", "Context", true);
+	// Spawning can wait for a frame with budget left, the shot carries its own copy of the fire command.
+	// Later shots of a burst keep the aim of the command, so every machine expands the same pellet directions,
+	// but leave from where the shooter is now instead of where it stood when the trigger was pulled.
+	TWeakObjectPtr<AMyProjectCharacter> WeakThis(this);
+	const int32 FireSeed = BurstFireSeed;
+	const int32 ShotIndex = BurstShotIndex;
+	const FVector FireLocation = ShotIndex == 0 ? BurstFireLocation : GetProjectileFireLocation();
+	const FRotator FireRotation = BurstFireRotation;
+	UCombatWorkScheduler::SubmitWork(this, ECombatWorkSystem::ProjectileSpawn, ECombatWorkPriority::High, ProjectileSpawnMaxDelay,
+		[WeakThis, FireSeed, ShotIndex, FireLocation, FireRotation]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->SpawnProjectileShot(FireSeed, ShotIndex, FireLocation, FireRotation);
+			}
+		});
+	++BurstShotIndex;
 
-	// cooldown timer start
-	if (AllowToShoot)
+	if (BurstShotIndex < dataTableData->BurstShotCount)
+	{
+		const float ShotInterval = FMath::Max(dataTableData->BurstShotInterval, KINDA_SMALL_NUMBER);
+		GetWorldTimerManager().SetTimer(BurstTimerHandle, this, &AMyProjectCharacter::SpawnNextBurstShot, ShotInterval, false);
+	}
+}
+
+FVector AMyProjectCharacter::GetProjectileFireLocation() const
+{
+	return (GetActorForwardVector() * 50) + GetActorLocation();
+}
+
+void AMyProjectCharacter::SpawnProjectileShot(int32 FireSeed, int32 ShotIndex, FVector FireLocation, FRotator FireRotation)
+{
+	COMBAT_LLM_SCOPE(Projectiles);
+
+	UWorld* p_World = GetWorld();
+	FProjectileDataStruct* dataTableData = UHelperLibrary::GetProjectileDataRow(ProjectileDataTable, "HighScore");
+
+	bool bValid = IsValid(p_World) && IsValid(ProjectileToSpawnClass) && dataTableData;
+	if (!bValid)
 	{
-		StartCoolDownTimer(dataTableData->CooldownDelayForShoot);
+		return;
+	}
 
-		UWorld* p_World = GetWorld();
+	TArray<FRotator> PelletRotations;
+	UHelperLibrary::GetProjectileSpreadRotations(*dataTableData, FireSeed, ShotIndex, FireRotation, PelletRotations);
 
-		bool bValid = IsValid(p_World) && IsValid(ProjectileToSpawnClass);
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = this;
+	SpawnParams.Instigator = GetInstigator();
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.bDeferConstruction = true;
 
-		if (bValid && dataTableData->bEnabledProjectileSpawnSystem)
+	TArray<AProjectileActor*, TInlineAllocator<16>> Pellets;
+	for (const FRotator& PelletRotation : PelletRotations)
+	{
+		AProjectileActor* Projectile = p_World->SpawnActor<AProjectileActor>(ProjectileToSpawnClass, FireLocation, PelletRotation, SpawnParams);
+		if (Projectile)
 		{
-			FActorSpawnParameters SpawnParams;
-			SpawnParams.Owner = this;
-			SpawnParams.Instigator = GetInstigator();
+			// Every machine spawns its own pellets from the fire command, so they are never replicated.
+			Projectile->SetReplicates(false);
+			Projectile->ProjectileDataTable = ProjectileDataTable;
+			Projectile->FinishSpawning(FTransform(PelletRotation, FireLocation));
+			Pellets.Add(Projectile);
+		}
+	}
 
-			FVector SpawnLocation = (GetActorForwardVector() * 50) + GetActorLocation();
-			AProjectileActor* Projectile = p_World->SpawnActor<AProjectileActor>(ProjectileToSpawnClass, SpawnLocation, GetActorRotation(), SpawnParams);
-			if (Projectile)
+	// Pellets of the same shot start at the same location, don't let them hit each other or the shooter they spawn next to.
+	for (AProjectileActor* Pellet : Pellets)
+	{
+		Pellet->CollisionComponent->IgnoreActorWhenMoving(this, true);
+		for (AProjectileActor* OtherPellet : Pellets)
+		{
+			if (Pellet != OtherPellet)
 			{
-				// Do something - 
+				Pellet->CollisionComponent->IgnoreActorWhenMoving(OtherPellet, true);
 			}
 		}
 	}
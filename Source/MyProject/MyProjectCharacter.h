@@ -34,6 +34,13 @@ public:
 
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void PostInitializeComponents() override;
+
+protected:
+	virtual void BeginPlay() override;
+
+public:
+
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
 	float BaseTurnRate;
@@ -79,7 +86,28 @@ public:
 	UFUNCTION(Server, reliable)
 	void  SpawnProjectile();
 	UFUNCTION(NetMulticast, reliable)
-	void  SpawnProjectileClient();
+	void  SpawnProjectileClient(int32 FireSeed, FVector_NetQuantize FireLocation, FRotator FireRotation);
+
+		// Spawns every pellet of one shot of a fire command.
+		void SpawnProjectileShot(int32 FireSeed, int32 ShotIndex, FVector FireLocation, FRotator FireRotation);
+
+		// Spawns the next shot of the current burst and schedules the one after it.
+		void SpawnNextBurstShot();
+
+		// Where projectiles leave the character, in front of the capsule.
+		FVector GetProjectileFireLocation() const;
+
+		// Fire command currently being expanded. Shots after the first one are spawned from the burst timer.
+		// BurstFireLocation is only used by the first shot, later ones leave from the current fire location.
+		FTimerHandle BurstTimerHandle;
+		int32 BurstFireSeed = 0;
+		int32 BurstShotIndex = 0;
+		FVector BurstFireLocation;
+		FRotator BurstFireRotation;
+
+		// Longest time in seconds the combat work scheduler may hold back a shot when the frame budget is spent.
+		UPROPERTY(EditDefaultsOnly, Category = Projectile)
+		float ProjectileSpawnMaxDelay = 0.05f;
 
 		// Projectile class for spawn.
 		UPROPERTY(EditDefaultsOnly, Category = Projectile)
@@ -3,6 +3,7 @@
 #include "MyProjectGameMode.h"
 #include "MyProjectCharacter.h"
 #include "UObject/ConstructorHelpers.h"
+#include "Memory/CombatLLM.h"
 
 AMyProjectGameMode::AMyProjectGameMode()
 {
@@ -13,3 +14,11 @@ AMyProjectGameMode::AMyProjectGameMode()
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
 }
+
+APawn* AMyProjectGameMode::SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform)
+{
+	// Covers component registration and physics state, which happen before the character's own scoped functions.
+	COMBAT_LLM_SCOPE(Characters);
+
+	return Super::SpawnDefaultPawnAtTransform_Implementation(NewPlayer, SpawnTransform);
+}
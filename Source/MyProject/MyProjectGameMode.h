@@ -13,6 +13,9 @@ class AMyProjectGameMode : public AGameModeBase
 
 public:
 	AMyProjectGameMode();
+
+	// Spawns the pawn of a player. Everything the character allocates while spawning is tagged as combat characters.
+	virtual APawn* SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform) override;
 };
 
 
@@ -2,10 +2,15 @@
 
 
 #include "ProjectileActor.h"
+#include "../Memory/CombatLLM.h"
+#include "../Memory/CombatMemoryTracker.h"
+#include "../Scheduling/CombatWorkScheduler.h"
 
 // Sets default values
 AProjectileActor::AProjectileActor()
 {
+	COMBAT_LLM_SCOPE(Projectiles);
+
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 	SetupProjectileProperties();
@@ -22,23 +27,54 @@ AProjectileActor::AProjectileActor()
 // Get Data table values.
 UDataTable* AProjectileActor::GetProjectileDataTable()
 {
-	return Cast<AMyProjectCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0))->ProjectileDataTable;
+	// Set by whoever spawned the projectile, otherwise fall back to the table of the first player.
+	if (ProjectileDataTable)
+	{
+		return ProjectileDataTable;
+	}
+
+	auto player = Cast<AMyProjectCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	return player ? player->ProjectileDataTable : nullptr;
 }
 
 
 void AProjectileActor::BeginPlay()
 {
+	COMBAT_LLM_SCOPE(Projectiles);
+
 	Super::BeginPlay();
 	
 	// Get Data table row from struct and set required values
-	auto dataTableData = UHelperLibrary::GetProjectileDataRow(GetProjectileDataTable(), "HighScore");
-	SetActorScale3D(dataTableData->ProjectileSize);
-	const FString CollisionProfileNameOfProjectile = dataTableData->ProjectileCollisonProfileName;
+	if (auto dataTableData = UHelperLibrary::GetProjectileDataRow(GetProjectileDataTable(), "HighScore"))
+	{
+		ApplyProjectileData(*dataTableData);
+	}
+
+	if (UCombatMemoryTracker* MemoryTracker = UCombatMemoryTracker::Get(this))
+	{
+		MemoryTracker->RegisterProjectile(this);
+	}
+}
+
+void AProjectileActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCombatMemoryTracker* MemoryTracker = UCombatMemoryTracker::Get(this))
+	{
+		MemoryTracker->UnregisterProjectile(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AProjectileActor::ApplyProjectileData(const FProjectileDataStruct& ProjectileData)
+{
+	SetActorScale3D(ProjectileData.ProjectileSize);
+	const FString CollisionProfileNameOfProjectile = ProjectileData.ProjectileCollisonProfileName;
 	CollisionComponent->SetCollisionProfileName(FName(CollisionProfileNameOfProjectile));
-	ProjectileMovementComponent->InitialSpeed = dataTableData->ProjectileSpeed;
-	ProjectileMovementComponent->MaxSpeed = dataTableData->ProjectileSpeed;
-	ProjectileMovementComponent->ProjectileGravityScale = dataTableData->ProjectileGravityInFloat;
-	ProjectileMeshComponent->SetStaticMesh(dataTableData->ProjectileMesh);
+	ProjectileMovementComponent->InitialSpeed = ProjectileData.ProjectileSpeed;
+	ProjectileMovementComponent->MaxSpeed = ProjectileData.ProjectileSpeed;
+	ProjectileMovementComponent->ProjectileGravityScale = ProjectileData.ProjectileGravityInFloat;
+	ProjectileMeshComponent->SetStaticMesh(ProjectileData.ProjectileMesh);
 }
 
 // Called every frame
@@ -115,7 +151,16 @@ void AProjectileActor::SetupProjectileProperties()
 			}
 			if (OtherActor->ActorHasTag("destructible"))
 			{
-				OtherActor->Destroy();
+				// Destroying is the most expensive part of a hit and nothing waits for it, let it run when there is budget.
+				TWeakObjectPtr<AActor> WeakOtherActor(OtherActor);
+				UCombatWorkScheduler::SubmitWork(this, ECombatWorkSystem::Destruction, ECombatWorkPriority::Low, DestructionMaxDelay,
+					[WeakOtherActor]()
+					{
+						if (WeakOtherActor.IsValid())
+						{
+							WeakOtherActor->Destroy();
+						}
+					});
 			}
 		}
 
@@ -124,9 +169,45 @@ void AProjectileActor::SetupProjectileProperties()
 		{
 			auto dataTableData = UHelperLibrary::GetProjectileDataRow(GetProjectileDataTable(), "HighScore");
 
-			if (OtherActor != this)
+			// A projectile waiting to be destroyed doesn't hit anything else.
+			if (!dataTableData || bHitResolutionPending)
 			{
-				OnProjectileHit_Server_Implementation(OtherActor, OtherComp, Hit);
+				return;
+			}
+
+			// Projectiles are spawned locally on every machine, only the server resolves the hit.
+			if (OtherActor != this && GetNetMode() != NM_Client)
+			{
+				const bool bDestroyAfterHit = dataTableData->bDestroyOnHit;
+				if (bDestroyAfterHit)
+				{
+					// Keep the projectile around until its hit is resolved, but take it out of the game right away.
+					bHitResolutionPending = true;
+					SetActorHiddenInGame(true);
+					SetActorEnableCollision(false);
+					ProjectileMovementComponent->StopMovementImmediately();
+				}
+
+				TWeakObjectPtr<AProjectileActor> WeakThis(this);
+				TWeakObjectPtr<AActor> WeakOtherActor(OtherActor);
+				TWeakObjectPtr<UPrimitiveComponent> WeakOtherComp(OtherComp);
+				UCombatWorkScheduler::SubmitWork(this, ECombatWorkSystem::HitResolution, ECombatWorkPriority::Normal, HitResolutionMaxDelay,
+					[WeakThis, WeakOtherActor, WeakOtherComp, Hit, bDestroyAfterHit]()
+					{
+						if (!WeakThis.IsValid())
+						{
+							return;
+						}
+						if (WeakOtherActor.IsValid())
+						{
+							WeakThis->OnProjectileHit_Server_Implementation(WeakOtherActor.Get(), WeakOtherComp.Get(), Hit);
+						}
+						if (bDestroyAfterHit)
+						{
+							WeakThis->Destroy();
+						}
+					});
+				return;
 			}
 			if (dataTableData->bDestroyOnHit)
 			{
@@ -31,10 +31,15 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	// Applies size, collision, speed and mesh of a data table row. Called from BeginPlay.
+	void ApplyProjectileData(const FProjectileDataStruct& ProjectileData);
+
 	
 	// Sphere collision component.
 	UPROPERTY(VisibleDefaultsOnly, Category = Projectile)
@@ -70,6 +75,16 @@ public:
 	UFUNCTION()
 	 void OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit) ;
 
+	// Longest time in seconds the combat work scheduler may hold back hit resolution and destruction of what was hit.
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	float HitResolutionMaxDelay = 0.05f;
+
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	float DestructionMaxDelay = 0.25f;
+
+	// Set once a hit is queued for resolution and the projectile is only waiting to be destroyed.
+	bool bHitResolutionPending = false;
+
 	// reference to player character. can be used later.
 	UPROPERTY()
 	class AMyProjectCharacter* character_ptr;
@@ -78,6 +93,10 @@ public:
 	UFUNCTION()
 	UDataTable* GetProjectileDataTable();
 
+	// Data table of the character that fired this projectile. Set before the projectile finishes spawning.
+	UPROPERTY()
+	UDataTable* ProjectileDataTable;
+
 
 	// Networking functions
 	UFUNCTION(Server, Reliable)
@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatWorkScheduler.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "../Memory/CombatLLM.h"
+
+DECLARE_STATS_GROUP(TEXT("CombatScheduler"), STATGROUP_CombatScheduler, STATCAT_Advanced);
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Projectile spawn (ms)"), STAT_CombatScheduler_ProjectileSpawnMs, STATGROUP_CombatScheduler);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Hit resolution (ms)"), STAT_CombatScheduler_HitResolutionMs, STATGROUP_CombatScheduler);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Destruction (ms)"), STAT_CombatScheduler_DestructionMs, STATGROUP_CombatScheduler);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Projectile spawn worker (ms)"), STAT_CombatScheduler_ProjectileSpawnWorkerMs, STATGROUP_CombatScheduler);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Hit resolution worker (ms)"), STAT_CombatScheduler_HitResolutionWorkerMs, STATGROUP_CombatScheduler);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Destruction worker (ms)"), STAT_CombatScheduler_DestructionWorkerMs, STATGROUP_CombatScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Work run"), STAT_CombatScheduler_NumRun, STATGROUP_CombatScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Work run past deadline"), STAT_CombatScheduler_NumOverdue, STATGROUP_CombatScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Work carried over"), STAT_CombatScheduler_NumPending, STATGROUP_CombatScheduler);
+
+static TAutoConsoleVariable<float> CVarCombatFrameBudgetMs(
+	TEXT("Combat.Scheduler.FrameBudgetMs"),
+	4.f,
+	TEXT("Game thread time in milliseconds the combat work scheduler may spend per frame.\n")
+	TEXT("Work past its deadline runs regardless of the budget. 0 or less runs all pending work every frame."),
+	ECVF_Default);
+
+
+UCombatWorkScheduler* UCombatWorkScheduler::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	return World ? World->GetSubsystem<UCombatWorkScheduler>() : nullptr;
+}
+
+void UCombatWorkScheduler::SubmitWork(const UObject* WorldContextObject, ECombatWorkSystem System, ECombatWorkPriority Priority, float MaxDelay, TFunction<void()>&& Work)
+{
+	UCombatWorkScheduler* Scheduler = Get(WorldContextObject);
+	if (!Scheduler)
+	{
+		Work();
+		return;
+	}
+
+	FCombatWorkItem Item;
+	Item.System = System;
+	Item.Priority = Priority;
+	Item.Deadline = Scheduler->GetWorld()->GetTimeSeconds() + FMath::Max(MaxDelay, 0.f);
+	Item.bThreadSafe = false;
+	Item.Work = MoveTemp(Work);
+	Scheduler->QueueWork(MoveTemp(Item));
+}
+
+void UCombatWorkScheduler::SubmitThreadSafeWork(const UObject* WorldContextObject, ECombatWorkSystem System, ECombatWorkPriority Priority, float MaxDelay, TFunction<TFunction<void()>()>&& Work)
+{
+	UCombatWorkScheduler* Scheduler = Get(WorldContextObject);
+	if (!Scheduler)
+	{
+		if (TFunction<void()> Continuation = Work())
+		{
+			Continuation();
+		}
+		return;
+	}
+
+	FCombatWorkItem Item;
+	Item.System = System;
+	Item.Priority = Priority;
+	Item.Deadline = Scheduler->GetWorld()->GetTimeSeconds() + FMath::Max(MaxDelay, 0.f);
+	Item.bThreadSafe = true;
+	Item.ThreadSafeWork = MoveTemp(Work);
+	Scheduler->QueueWork(MoveTemp(Item));
+}
+
+void UCombatWorkScheduler::QueueWork(FCombatWorkItem&& Item)
+{
+	COMBAT_LLM_SCOPE(CombatManager);
+	FScopeLock Lock(&SubmittedWorkLock);
+	Item.Sequence = NextSequence++;
+	SubmittedWork.Add(MoveTemp(Item));
+}
+
+void UCombatWorkScheduler::DispatchThreadSafeWork(FCombatWorkItem&& Item)
+{
+	COMBAT_LLM_SCOPE(CombatManager);
+	const ECombatWorkSystem System = Item.System;
+	const ECombatWorkPriority Priority = Item.Priority;
+	const float Deadline = Item.Deadline;
+
+	// The scheduler waits for every in flight task before it goes away, so the raw pointer stays valid.
+	InFlightTasks.Add(FFunctionGraphTask::CreateAndDispatchWhenReady(
+		[this, System, Priority, Deadline, Work = MoveTemp(Item.ThreadSafeWork)]()
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			TFunction<void()> Continuation = Work();
+			WorkerThreadCycles[static_cast<int32>(System)] += FPlatformTime::Cycles64() - StartCycles;
+
+			if (Continuation)
+			{
+				FCombatWorkItem ContinuationItem;
+				ContinuationItem.System = System;
+				ContinuationItem.Priority = Priority;
+				ContinuationItem.Deadline = Deadline;
+				ContinuationItem.bThreadSafe = false;
+				ContinuationItem.Work = MoveTemp(Continuation);
+				QueueWork(MoveTemp(ContinuationItem));
+			}
+		},
+		TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask));
+}
+
+void UCombatWorkScheduler::Tick(float DeltaTime)
+{
+	FMemory::Memzero(GameThreadSeconds);
+
+	// Worker time is collected from whatever tasks finished since the last frame.
+	for (int32 SystemIndex = 0; SystemIndex < static_cast<int32>(ECombatWorkSystem::Count); ++SystemIndex)
+	{
+		WorkerThreadSeconds[SystemIndex] = FPlatformTime::ToSeconds64(WorkerThreadCycles[SystemIndex].exchange(0));
+	}
+
+	NumRunLastFrame = 0;
+	NumOverdueLastFrame = 0;
+
+	InFlightTasks.RemoveAllSwap([](const FGraphEventRef& Task) { return Task->IsComplete(); });
+
+	{
+		COMBAT_LLM_SCOPE(CombatManager);
+		FScopeLock Lock(&SubmittedWorkLock);
+		PendingWork.Append(MoveTemp(SubmittedWork));
+		SubmittedWork.Reset();
+	}
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	// Thread safe work doesn't cost game thread budget, hand all of it to the task graph right away.
+	for (int32 Index = PendingWork.Num() - 1; Index >= 0; --Index)
+	{
+		if (PendingWork[Index].bThreadSafe)
+		{
+			DispatchThreadSafeWork(MoveTemp(PendingWork[Index]));
+			PendingWork.RemoveAt(Index, 1, false);
+		}
+	}
+
+	// Work that must run this frame first, then by priority, deadline and submit order.
+	PendingWork.Sort([Now](const FCombatWorkItem& A, const FCombatWorkItem& B)
+	{
+		const bool bAMustRun = A.Deadline <= Now || A.Priority == ECombatWorkPriority::Critical;
+		const bool bBMustRun = B.Deadline <= Now || B.Priority == ECombatWorkPriority::Critical;
+		if (bAMustRun != bBMustRun)
+		{
+			return bAMustRun;
+		}
+		if (A.Priority != B.Priority)
+		{
+			return A.Priority > B.Priority;
+		}
+		if (A.Deadline != B.Deadline)
+		{
+			return A.Deadline < B.Deadline;
+		}
+		return A.Sequence < B.Sequence;
+	});
+
+	const float BudgetMs = CVarCombatFrameBudgetMs.GetValueOnGameThread();
+	const double BudgetSeconds = BudgetMs > 0.f ? BudgetMs / 1000.0 : TNumericLimits<double>::Max();
+	const double FrameStartTime = FPlatformTime::Seconds();
+	double CurrentTime = FrameStartTime;
+
+	// Work submitted while running lands in SubmittedWork, so PendingWork doesn't change under the loop.
+	int32 NumRun = 0;
+	for (; NumRun < PendingWork.Num(); ++NumRun)
+	{
+		FCombatWorkItem& Item = PendingWork[NumRun];
+		const bool bOverdue = Item.Deadline <= Now;
+		if (!bOverdue && Item.Priority != ECombatWorkPriority::Critical && CurrentTime - FrameStartTime >= BudgetSeconds)
+		{
+			break;
+		}
+
+		const double ItemStartTime = CurrentTime;
+		Item.Work();
+		CurrentTime = FPlatformTime::Seconds();
+
+		GameThreadSeconds[static_cast<int32>(Item.System)] += CurrentTime - ItemStartTime;
+		NumOverdueLastFrame += bOverdue ? 1 : 0;
+	}
+
+	NumRunLastFrame = NumRun;
+	PendingWork.RemoveAt(0, NumRun, false);
+
+	PublishStats();
+}
+
+void UCombatWorkScheduler::PublishStats()
+{
+	SET_FLOAT_STAT(STAT_CombatScheduler_ProjectileSpawnMs, GetSystemTimeLastFrameMs(ECombatWorkSystem::ProjectileSpawn));
+	SET_FLOAT_STAT(STAT_CombatScheduler_HitResolutionMs, GetSystemTimeLastFrameMs(ECombatWorkSystem::HitResolution));
+	SET_FLOAT_STAT(STAT_CombatScheduler_DestructionMs, GetSystemTimeLastFrameMs(ECombatWorkSystem::Destruction));
+	SET_FLOAT_STAT(STAT_CombatScheduler_ProjectileSpawnWorkerMs, GetSystemWorkerTimeLastFrameMs(ECombatWorkSystem::ProjectileSpawn));
+	SET_FLOAT_STAT(STAT_CombatScheduler_HitResolutionWorkerMs, GetSystemWorkerTimeLastFrameMs(ECombatWorkSystem::HitResolution));
+	SET_FLOAT_STAT(STAT_CombatScheduler_DestructionWorkerMs, GetSystemWorkerTimeLastFrameMs(ECombatWorkSystem::Destruction));
+
+	SET_DWORD_STAT(STAT_CombatScheduler_NumRun, NumRunLastFrame);
+	SET_DWORD_STAT(STAT_CombatScheduler_NumOverdue, NumOverdueLastFrame);
+	SET_DWORD_STAT(STAT_CombatScheduler_NumPending, PendingWork.Num());
+}
+
+SIZE_T UCombatWorkScheduler::GetAllocatedSize() const
+{
+	FScopeLock Lock(&SubmittedWorkLock);
+	return sizeof(*this) + PendingWork.GetAllocatedSize() + SubmittedWork.GetAllocatedSize() + InFlightTasks.GetAllocatedSize();
+}
+
+float UCombatWorkScheduler::GetSystemTimeLastFrameMs(ECombatWorkSystem System) const
+{
+	return static_cast<float>(GameThreadSeconds[static_cast<int32>(System)] * 1000.0);
+}
+
+float UCombatWorkScheduler::GetSystemWorkerTimeLastFrameMs(ECombatWorkSystem System) const
+{
+	return static_cast<float>(WorkerThreadSeconds[static_cast<int32>(System)] * 1000.0);
+}
+
+void UCombatWorkScheduler::WaitForThreadSafeWork()
+{
+	FTaskGraphInterface::Get().WaitUntilTasksComplete(InFlightTasks, ENamedThreads::GameThread);
+	InFlightTasks.Reset();
+}
+
+void UCombatWorkScheduler::Deinitialize()
+{
+	WaitForThreadSafeWork();
+
+	// Work left over belongs to a world that is going away.
+	PendingWork.Reset();
+	{
+		FScopeLock Lock(&SubmittedWorkLock);
+		SubmittedWork.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UCombatWorkScheduler::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return !IsTemplate() && World && World->IsGameWorld();
+}
+
+TStatId UCombatWorkScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatWorkScheduler, STATGROUP_Tickables);
+}
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Async/TaskGraphInterfaces.h"
+#include <atomic>
+#include "CombatWorkScheduler.generated.h"
+
+
+// Combat systems that submit work to the scheduler. Budget consumption is tracked per system.
+UENUM(BlueprintType)
+enum class ECombatWorkSystem : uint8
+{
+	ProjectileSpawn,
+	HitResolution,
+	Destruction,
+	Count UMETA(Hidden)
+};
+
+// Higher priority work runs first. Critical work always runs in the frame it is scheduled.
+UENUM(BlueprintType)
+enum class ECombatWorkPriority : uint8
+{
+	Low,
+	Normal,
+	High,
+	Critical
+};
+
+/**
+ * Spends a fixed time budget per frame on deferrable combat work.
+ * Work that doesn't fit the budget is carried over to the next frame, unless its deadline has passed.
+ * Budget is set with the console variable Combat.Scheduler.FrameBudgetMs, consumption is shown by "stat CombatScheduler".
+ */
+UCLASS()
+class MYPROJECT_API UCombatWorkScheduler : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Returns the scheduler of the world, or nullptr if there is none.
+	static UCombatWorkScheduler* Get(const UObject* WorldContextObject);
+
+	// Queues game thread work that may be delayed by at most MaxDelay seconds. Runs it right away if there is no scheduler.
+	static void SubmitWork(const UObject* WorldContextObject, ECombatWorkSystem System, ECombatWorkPriority Priority, float MaxDelay, TFunction<void()>&& Work);
+
+	// Queues thread safe work that runs on a worker thread of the task graph. The continuation it returns (if any)
+	// is queued back on the game thread with the same system, priority and deadline.
+	static void SubmitThreadSafeWork(const UObject* WorldContextObject, ECombatWorkSystem System, ECombatWorkPriority Priority, float MaxDelay, TFunction<TFunction<void()>()>&& Work);
+
+	// Game thread time spent by a system during the last frame, in milliseconds.
+	float GetSystemTimeLastFrameMs(ECombatWorkSystem System) const;
+
+	// Worker thread time of a system collected during the last frame, in milliseconds.
+	float GetSystemWorkerTimeLastFrameMs(ECombatWorkSystem System) const;
+
+	// Blocks until every thread safe work item handed to the task graph has finished. Their continuations run on a following tick.
+	void WaitForThreadSafeWork();
+
+	// Number of work items still waiting to run.
+	int32 GetNumPendingWork() const { return PendingWork.Num(); }
+
+	// Memory used by the scheduler and its queues.
+	SIZE_T GetAllocatedSize() const;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	// End of FTickableGameObject interface
+
+private:
+	struct FCombatWorkItem
+	{
+		ECombatWorkSystem System;
+		ECombatWorkPriority Priority;
+		// World time after which the work runs even if the frame budget is spent.
+		float Deadline;
+		// Submit order, keeps work of equal priority and deadline in order.
+		uint64 Sequence;
+		bool bThreadSafe;
+		TFunction<void()> Work;
+		TFunction<TFunction<void()>()> ThreadSafeWork;
+	};
+
+	void QueueWork(FCombatWorkItem&& Item);
+
+	void DispatchThreadSafeWork(FCombatWorkItem&& Item);
+
+	void PublishStats();
+
+	// Work waiting for a frame with enough budget. Only touched on the game thread.
+	TArray<FCombatWorkItem> PendingWork;
+
+	// Work submitted since the last tick, possibly from worker threads.
+	TArray<FCombatWorkItem> SubmittedWork;
+	mutable FCriticalSection SubmittedWorkLock;
+	uint64 NextSequence = 0;
+
+	// Worker thread tasks that haven't completed yet.
+	FGraphEventArray InFlightTasks;
+
+	double GameThreadSeconds[static_cast<int32>(ECombatWorkSystem::Count)] = {};
+	double WorkerThreadSeconds[static_cast<int32>(ECombatWorkSystem::Count)] = {};
+	// Added to by worker threads, collected into WorkerThreadSeconds every tick.
+	std::atomic<uint64> WorkerThreadCycles[static_cast<int32>(ECombatWorkSystem::Count)] = {};
+	int32 NumRunLastFrame = 0;
+	int32 NumOverdueLastFrame = 0;
+};
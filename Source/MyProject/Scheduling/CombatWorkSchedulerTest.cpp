@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "CombatWorkScheduler.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Ordering, frame budget, carry over and the worker thread path of the combat work scheduler.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatWorkSchedulerTest, "MyProject.Scheduling.CombatWorkScheduler",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCombatWorkSchedulerTest::RunTest(const FString& Parameters)
+{
+	IConsoleVariable* FrameBudgetMs = IConsoleManager::Get().FindConsoleVariable(TEXT("Combat.Scheduler.FrameBudgetMs"));
+	if (!TestNotNull(TEXT("Frame budget console variable"), FrameBudgetMs))
+	{
+		return false;
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	UCombatWorkScheduler* Scheduler = World->GetSubsystem<UCombatWorkScheduler>();
+	if (TestNotNull(TEXT("Scheduler of the world"), Scheduler))
+	{
+		// A budget this small lets at most one deferrable item run per tick.
+		const float PreviousBudgetMs = FrameBudgetMs->GetFloat();
+		FrameBudgetMs->Set(0.000001f, ECVF_SetByCode);
+
+		TArray<FString> RunOrder;
+		auto Record = [&RunOrder](const TCHAR* Name)
+		{
+			return [&RunOrder, Name]() { RunOrder.Add(Name); };
+		};
+
+		// World time stays at 0, so a max delay of 0 is overdue on the first tick and anything else is not.
+		UCombatWorkScheduler::SubmitWork(World, ECombatWorkSystem::Destruction, ECombatWorkPriority::Low, 10.f, Record(TEXT("LowLate")));
+		UCombatWorkScheduler::SubmitWork(World, ECombatWorkSystem::ProjectileSpawn, ECombatWorkPriority::High, 10.f, Record(TEXT("HighLate")));
+		UCombatWorkScheduler::SubmitWork(World, ECombatWorkSystem::HitResolution, ECombatWorkPriority::Normal, 0.f, [&RunOrder, World, Record]()
+		{
+			RunOrder.Add(TEXT("Overdue"));
+			// Submitted while the scheduler runs, lands in the next frame.
+			UCombatWorkScheduler::SubmitWork(World, ECombatWorkSystem::HitResolution, ECombatWorkPriority::Critical, 10.f, Record(TEXT("SubmittedDuringTick")));
+		});
+		UCombatWorkScheduler::SubmitWork(World, ECombatWorkSystem::HitResolution, ECombatWorkPriority::Critical, 10.f, Record(TEXT("Critical")));
+		UCombatWorkScheduler::SubmitWork(World, ECombatWorkSystem::ProjectileSpawn, ECombatWorkPriority::High, 5.f, Record(TEXT("HighEarly")));
+		UCombatWorkScheduler::SubmitWork(World, ECombatWorkSystem::ProjectileSpawn, ECombatWorkPriority::High, 10.f, Record(TEXT("HighLateSecond")));
+
+		// Must run work ignores the budget, the budget is spent once it is done so nothing deferrable follows.
+		Scheduler->Tick(0.f);
+		TestTrue(TEXT("First tick runs critical, then overdue work"), RunOrder == TArray<FString>({ TEXT("Critical"), TEXT("Overdue") }));
+		TestEqual(TEXT("Pending after first tick"), Scheduler->GetNumPendingWork(), 4);
+
+		Scheduler->Tick(0.f);
+		TestEqual(TEXT("Work submitted during a tick runs in the next one"), RunOrder.Last(), FString(TEXT("SubmittedDuringTick")));
+		TestEqual(TEXT("Pending after second tick"), Scheduler->GetNumPendingWork(), 4);
+
+		// Without must run work, one deferrable item fits per tick: by priority, then deadline, then submit order.
+		for (int32 TickIndex = 0; TickIndex < 4; ++TickIndex)
+		{
+			Scheduler->Tick(0.f);
+			TestEqual(FString::Printf(TEXT("Pending after deferrable tick %d"), TickIndex), Scheduler->GetNumPendingWork(), 3 - TickIndex);
+		}
+		TestTrue(TEXT("Full run order"), RunOrder == TArray<FString>({ TEXT("Critical"), TEXT("Overdue"), TEXT("SubmittedDuringTick"),
+			TEXT("HighEarly"), TEXT("HighLate"), TEXT("HighLateSecond"), TEXT("LowLate") }));
+
+		// Thread safe work goes to the task graph, its continuation comes back to the game thread.
+		bool bWorkRanOnGameThread = true;
+		bool bContinuationRanOnGameThread = false;
+		UCombatWorkScheduler::SubmitThreadSafeWork(World, ECombatWorkSystem::HitResolution, ECombatWorkPriority::Normal, 10.f,
+			[&bWorkRanOnGameThread, &bContinuationRanOnGameThread]() -> TFunction<void()>
+			{
+				bWorkRanOnGameThread = IsInGameThread();
+				return [&bContinuationRanOnGameThread]() { bContinuationRanOnGameThread = IsInGameThread(); };
+			});
+
+		Scheduler->Tick(0.f);
+		Scheduler->WaitForThreadSafeWork();
+		TestFalse(TEXT("Continuation waits for a tick"), bContinuationRanOnGameThread);
+		if (FApp::ShouldUseThreadingForPerformance())
+		{
+			TestFalse(TEXT("Thread safe work ran on a worker thread"), bWorkRanOnGameThread);
+		}
+
+		Scheduler->Tick(0.f);
+		TestTrue(TEXT("Continuation ran on the game thread"), bContinuationRanOnGameThread);
+		TestEqual(TEXT("Nothing pending after the continuation"), Scheduler->GetNumPendingWork(), 0);
+
+		FrameBudgetMs->Set(PreviousBudgetMs, ECVF_SetByCode);
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+#endif